@@ -1 +1 @@
-g++ main.cpp -lgmp -std=gnu++0x
+g++ main.cpp -lgmp -std=gnu++20 -O2 -pthread